@@ -0,0 +1,60 @@
+//
+//  Benchmark.cpp
+//  CubeSorting
+//
+//  Created by agent on 19/10/2026.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "Benchmark.h"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "Geometry.h"
+#include "Fitting.h"
+
+int benchmarkPrecision(int nCubes){
+    double pi = std::acos(-1);
+    std::mt19937 rng(1);  // Fixed seed, so runs are comparable
+    std::uniform_real_distribution<double> jitter(-0.15, 0.15);
+    
+    // Cube vertices in the order Objective expects the clicks.
+    int visible[7] = {0, 6, 4, 5, 1, 3, 2};
+    
+    double errorDouble = 0;
+    double errorFloat = 0;
+    double timeDouble = 0;
+    double timeFloat = 0;
+    for (int n = 0; n < nCubes; ++n) {
+        geom::Cube cube({jitter(rng), -pi/4 + jitter(rng), -pi/4 + jitter(rng), -1 + jitter(rng),
+                         1000 + 300*jitter(rng), 240 + 300*jitter(rng), 320 + 300*jitter(rng)});
+        std::vector<geom::Point2d> projected = cube.projectPoints();
+        std::vector<geom::Point2d> pointsDouble;
+        std::vector<geom::Point2f> pointsFloat;
+        for (int i = 0; i < 7; ++i) {
+            geom::Point2d p = projected[visible[i]];
+            pointsDouble.push_back(p);
+            pointsFloat.push_back(geom::Point2f(p.xy[0], p.xy[1]));
+        }
+        
+        auto start = std::chrono::steady_clock::now();
+        geom::vec fitDouble = geom::fitCube<double>(pointsDouble, 480, 640, false);
+        auto middle = std::chrono::steady_clock::now();
+        std::vector<float> fitFloat = geom::fitCube<float>(pointsFloat, 480, 640, false);
+        auto end = std::chrono::steady_clock::now();
+        timeDouble += std::chrono::duration<double>(middle - start).count();
+        timeFloat += std::chrono::duration<double>(end - middle).count();
+        
+        geom::Objective F(pointsDouble);
+        errorDouble += std::sqrt(F(fitDouble)/7);
+        errorFloat += std::sqrt(F(geom::vec(fitFloat.begin(), fitFloat.end()))/7);
+    }
+    
+    std::cout << "Fitted " << nCubes << " synthetic cubes" << std::endl;
+    std::cout << "double: mean rms " << errorDouble/nCubes << " px, " << timeDouble << " s" << std::endl;
+    std::cout << "float:  mean rms " << errorFloat/nCubes << " px, " << timeFloat << " s" << std::endl;
+    return 0;
+}
@@ -0,0 +1,21 @@
+//
+//  Benchmark.h
+//  CubeSorting
+//
+//  Created by agent on 19/10/2026.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#ifndef __CubeSorting__Benchmark__
+#define __CubeSorting__Benchmark__
+
+#include <stdio.h>
+
+/*
+ Compares the float and double fitting paths on nCubes synthetic cubes in a 480x640 image. Each cube is projected exactly, then fitted with geom::fitCube<double> and geom::fitCube<float>. Prints the mean RMS vertex error in pixels and the total time for each, measuring both against the double objective.
+ 
+ Returns 0, for use as the exit status.
+ */
+int benchmarkPrecision(int nCubes);
+
+#endif /* defined(__CubeSorting__Benchmark__) */
@@ -0,0 +1,321 @@
+//
+//  Fitting.cpp
+//  CubeSorting
+//
+//  Created by agent on 19/10/2026.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "Fitting.h"
+#include <algorithm>
+#include <cmath>
+#include <future>
+
+#include "GradDesc.h"
+
+namespace geom {
+    
+    /*
+     The initial guess and rates are tuned for a 480x640 image, so fits are done in that frame. Returns how many of the caller's pixels make one pixel in that frame, and moves points into it.
+     */
+    template<typename T>
+    T _normalise(std::vector<Point2_<T>>& points, T width, T height){
+        T unit = std::max(width, height)/640;
+        for (auto it = points.begin(); it != points.end(); ++it) {
+            *it = (1/unit)*(*it);
+        }
+        return unit;
+    }
+    
+    // Moves parameters from the fitting frame back to the caller's.
+    template<typename T>
+    std::vector<T> _denormalise(std::vector<T> params, T unit){
+        // Scale and centre are in pixels, the rest are unaffected.
+        for (int i = 4; i < 7; ++i) {
+            params[i] *= unit;
+        }
+        return params;
+    }
+    
+    /*
+     The centre parameter is where the "central" vertex lands, so start it on the first click. Several cubes in one image are mostly off-centre, so the middle of the image is a poor start.
+     */
+    template<typename T>
+    std::vector<T> _initialGuess(Point2_<T> centre){
+        T pi = std::acos(T(-1));
+        return {0, -pi/4, -pi/4, -1, 1000, centre.xy[0], centre.xy[1]};
+    }
+    
+    template<typename T>
+    std::vector<T> _rates(){
+        return {0.000001, 0.000001, 0.000001, 0.0001, 10, 0.01, 0.01};
+    }
+    
+    template<typename T>
+    std::vector<T> fitCube(std::vector<Point2_<T>> points,
+                           T width,
+                           T height,
+                           bool verbose){
+        T unit = _normalise(points, width, height);
+        Objective_<T> F(points);  // Construct objective function with seen data
+        
+        std::vector<T> init = _initialGuess(points[0]);
+        std::vector<T> secondRate = _rates<T>();
+        std::vector<T> params = gd::gradientDescent<Objective_<T>>(F, init, secondRate, 10, verbose);
+        return _denormalise(params, unit);
+    }
+    
+    template std::vector<float> fitCube(std::vector<Point2f> points,
+                                        float width,
+                                        float height,
+                                        bool verbose);
+    template std::vector<double> fitCube(std::vector<Point2d> points,
+                                         double width,
+                                         double height,
+                                         bool verbose);
+    
+    
+    /*--- FitScheduler member functions ---*/
+    
+    // One fit in progress, in the fitting frame.
+    struct FitScheduler::Job {
+        Job(std::vector<Point2d> points, double unit, vec init, Callback callback)
+        : F(points), unit(unit), theta(init), best(init), bestValue(F(init)),
+          iterations(0), callback(callback) {}
+        Objective F;
+        double unit;
+        vec theta;
+        vec best;
+        double bestValue;
+        int iterations;
+        Callback callback;
+    };
+    
+    FitScheduler::FitScheduler(int nWorkers)
+    : _queues(nWorkers), _queued(0), _stopping(false), _nextQueue(0) {
+        for (int i = 0; i < nWorkers; ++i) {
+            _workers.push_back(std::thread(&FitScheduler::_work, this, i));
+        }
+    }
+    
+    FitScheduler::~FitScheduler(){
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _ready.notify_all();
+        for (auto it = _workers.begin(); it != _workers.end(); ++it) {
+            it->join();
+        }
+    }
+    
+    void FitScheduler::submit(std::vector<Point2d> points,
+                              double width,
+                              double height,
+                              Callback callback){
+        double unit = _normalise(points, width, height);
+        std::shared_ptr<Job> job(new Job(points, unit, _initialGuess(points[0]), callback));
+        if (!job->callback(_denormalise(job->best, unit), job->bestValue*unit*unit, 1, false, false)) {
+            return;
+        }
+        
+        int queue;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            queue = _nextQueue;
+            _nextQueue = (_nextQueue + 1) % _queues.size();
+        }
+        {
+            std::lock_guard<std::mutex> lock(_queues[queue].mutex);
+            _queues[queue].jobs.push_back(job);
+        }
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            ++_queued;
+        }
+        _ready.notify_one();
+    }
+    
+    std::future<vec> FitScheduler::submit(std::vector<Point2d> points,
+                                          double width,
+                                          double height){
+        std::shared_ptr<std::promise<vec>> result(new std::promise<vec>());
+        submit(points, width, height, [result](vec params, double, long, bool, bool finished) {
+            if (finished) {
+                result->set_value(params);
+            }
+            return true;
+        });
+        return result->get_future();
+    }
+    
+    std::shared_ptr<FitScheduler::Job> FitScheduler::_take(int worker){
+        // Own queue first, from the front so that fits take turns...
+        {
+            std::lock_guard<std::mutex> lock(_queues[worker].mutex);
+            if (!_queues[worker].jobs.empty()) {
+                std::shared_ptr<Job> job = _queues[worker].jobs.front();
+                _queues[worker].jobs.pop_front();
+                return job;
+            }
+        }
+        // ...then steal from the back of everyone else's.
+        for (int i = 1; i < _queues.size(); ++i) {
+            Queue& victim = _queues[(worker + i) % _queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.jobs.empty()) {
+                std::shared_ptr<Job> job = victim.jobs.back();
+                victim.jobs.pop_back();
+                return job;
+            }
+        }
+        return nullptr;
+    }
+    
+    void FitScheduler::_work(int worker){
+        vec rates = _rates<double>();
+        long evaluationsPerStep = rates.size() + 1;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _ready.wait(lock, [this]() { return _stopping || _queued > 0; });
+                if (_queued == 0) {
+                    return;  // stopping, and nothing left to do
+                }
+                --_queued;
+            }
+            // Jobs are only counted once they are in a queue, so there is
+            // one for us somewhere, even if someone steals the one we saw.
+            std::shared_ptr<Job> job;
+            while (!(job = _take(worker))) {
+                std::this_thread::yield();
+            }
+            
+            bool finished = gd::continueDescent<Objective>(job->F, job->theta, rates, 10,
+                                                           sliceSteps, job->iterations);
+            double value = job->F(job->theta);
+            bool improved = value < job->bestValue;
+            if (improved) {
+                job->best = job->theta;
+                job->bestValue = value;
+            }
+            // Report every slice, so that callers see evaluations being spent
+            // and can stop a fit which has stalled.
+            bool carryOn = job->callback(_denormalise(job->best, job->unit),
+                                         job->bestValue*job->unit*job->unit,
+                                         job->iterations*evaluationsPerStep,
+                                         improved,
+                                         finished);
+            
+            if (!finished && carryOn) {
+                {
+                    std::lock_guard<std::mutex> lock(_queues[worker].mutex);
+                    _queues[worker].jobs.push_back(job);
+                }
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    ++_queued;
+                }
+                _ready.notify_one();
+            }
+        }
+    }
+    
+    
+    /*--- AnytimeFit member functions ---*/
+    
+    // Shared with the scheduler, which may still hold it after the AnytimeFit has gone.
+    struct AnytimeFit::State {
+        std::mutex mutex;
+        std::condition_variable changed;
+        vec best;
+        double value;
+        long evaluations;
+        bool finished;
+        bool cancelled;
+        int version;
+        std::function<void(vec params, double value)> onImprove;
+    };
+    
+    AnytimeFit::AnytimeFit(FitScheduler& scheduler,
+                           std::vector<Point2d> points,
+                           double width,
+                           double height,
+                           std::function<void(vec params, double value)> onImprove)
+    : _state(new State()) {
+        _state->evaluations = 0;
+        _state->finished = false;
+        _state->cancelled = false;
+        _state->version = 0;
+        _state->onImprove = onImprove;
+        
+        std::shared_ptr<State> state = _state;
+        scheduler.submit(points, width, height, [state](vec params, double value, long evaluations, bool improved, bool finished) {
+            std::function<void(vec params, double value)> onImprove;
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (state->cancelled) {
+                    return false;
+                }
+                // The first call is the initial guess, from the constructor's thread.
+                bool first = state->version == 0;
+                if (first || improved) {
+                    state->best = params;
+                    state->value = value;
+                    ++state->version;
+                }
+                if (improved) {
+                    onImprove = state->onImprove;
+                }
+                state->evaluations = evaluations;
+                state->finished = finished;
+            }
+            state->changed.notify_all();
+            if (onImprove) {
+                onImprove(params, value);
+            }
+            return true;
+        });
+    }
+    
+    AnytimeFit::~AnytimeFit(){
+        std::lock_guard<std::mutex> lock(_state->mutex);
+        _state->cancelled = true;
+    }
+    
+    vec AnytimeFit::waitFor(std::chrono::milliseconds budget){
+        std::unique_lock<std::mutex> lock(_state->mutex);
+        _state->changed.wait_for(lock, budget, [this]() { return _state->finished; });
+        return _state->best;
+    }
+    
+    vec AnytimeFit::wait(){
+        std::unique_lock<std::mutex> lock(_state->mutex);
+        _state->changed.wait(lock, [this]() { return _state->finished; });
+        return _state->best;
+    }
+    
+    vec AnytimeFit::waitForEvaluations(long evaluations){
+        std::unique_lock<std::mutex> lock(_state->mutex);
+        _state->changed.wait(lock, [this, evaluations]() {
+            return _state->finished || _state->evaluations >= evaluations;
+        });
+        return _state->best;
+    }
+    
+    vec AnytimeFit::best(){
+        std::lock_guard<std::mutex> lock(_state->mutex);
+        return _state->best;
+    }
+    
+    bool AnytimeFit::finished(){
+        std::lock_guard<std::mutex> lock(_state->mutex);
+        return _state->finished;
+    }
+    
+    int AnytimeFit::version(){
+        std::lock_guard<std::mutex> lock(_state->mutex);
+        return _state->version;
+    }
+    
+} // namespace geom
@@ -0,0 +1,126 @@
+//
+//  Fitting.h
+//  CubeSorting
+//
+//  Created by agent on 19/10/2026.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#ifndef __CubeSorting__Fitting__
+#define __CubeSorting__Fitting__
+
+#include <stdio.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Geometry.h"
+
+namespace geom {
+    
+    // Number of user clicks needed to describe one cube.
+    const int pointsPerCube = 7;
+    
+    /*
+     Fits a single cube to 7 points of user input, ordered as for Objective. The points are taken to lie in an image of the given width and height. The initial guess puts the cube's centre on the first point. Any image size works: the fit is done in a frame scaled to 640 pixels on the long side and the result is scaled back. If verbose, the number of iterations taken is printed to stdout.
+     
+     Returns the fitted parameters
+        (thetaX, thetaY, thetaZ, cameraDist, scale, centreX, centreY)
+     
+     Instantiated for float and double in Fitting.cpp.
+     */
+    template<typename T>
+    std::vector<T> fitCube(std::vector<Point2_<T>> points,
+                           T width,
+                           T height,
+                           bool verbose = true);
+    
+    /*
+     Pool of workers for fitting many cubes at once without a slow fit holding up quick ones.
+     
+     Each fit is run in slices of sliceSteps gradient descent steps. A fit which hasn't finished after a slice goes to the back of its worker's queue, so the fits on one worker take turns. A worker with nothing left in its own queue steals from the others, so no worker sits idle while there are fits waiting.
+     */
+    class FitScheduler {
+    public:
+        /*
+         Called once from submit with the initial guess, on the submitting thread, then after every slice from a worker thread. Gets the best parameters so far (in the caller's frame, as for fitCube), the objective at those parameters, the number of objective evaluations spent so far, whether the last slice improved the fit, and whether the fit has finished. Return false to stop refining early.
+         */
+        typedef std::function<bool(vec params, double value, long evaluations, bool improved, bool finished)> Callback;
+        
+        static const int sliceSteps = 50;
+        
+        FitScheduler(int nWorkers);
+        ~FitScheduler();  // Waits for all fits to finish or be stopped.
+        
+        // Queues a fit of 7 points in an image of the given size. The initial guess is reported to callback straight away.
+        void submit(std::vector<Point2d> points,
+                    double width,
+                    double height,
+                    Callback callback);
+        
+        // Queues a fit, giving just the final parameters.
+        std::future<vec> submit(std::vector<Point2d> points,
+                                double width,
+                                double height);
+        
+    private:
+        struct Job;
+        struct Queue {
+            std::mutex mutex;
+            std::deque<std::shared_ptr<Job>> jobs;
+        };
+        void _work(int worker);
+        std::shared_ptr<Job> _take(int worker);
+        
+        std::vector<Queue> _queues;
+        std::mutex _mutex;  // Guards _queued and _stopping, for sleeping on _ready
+        std::condition_variable _ready;
+        int _queued;
+        bool _stopping;
+        int _nextQueue;
+        std::vector<std::thread> _workers;
+    };
+    
+    /*
+     A fit which gives a usable answer straight away and keeps improving it in the background.
+     
+     The initial guess is available immediately. Callers with a time or evaluation budget wait for that long and take whatever is best by then. The fit carries on refining on the scheduler until it finishes or this object is destroyed (which stops it within a slice), and onImprove (if given) is called from a worker thread whenever it gets better than the initial guess or the last improvement.
+     */
+    class AnytimeFit {
+    public:
+        AnytimeFit(FitScheduler& scheduler,
+                   std::vector<Point2d> points,
+                   double width,
+                   double height,
+                   std::function<void(vec params, double value)> onImprove = nullptr);
+        ~AnytimeFit();  // Stops refining
+        
+        // Waits until the fit has finished or the budget has run out, then returns the best so far.
+        vec waitFor(std::chrono::milliseconds budget);
+        
+        // Waits until the fit has finished, then returns it.
+        vec wait();
+        
+        // Waits until the fit has finished or used this many objective evaluations, then returns the best so far. Evaluations are counted a slice at a time, so this can overrun by up to one slice.
+        vec waitForEvaluations(long evaluations);
+        
+        vec best();
+        bool finished();
+        
+        // Goes up by one every time the best fit improves, to make polling for changes cheap.
+        int version();
+        
+    private:
+        struct State;
+        std::shared_ptr<State> _state;
+    };
+    
+} // namespace geom
+
+#endif /* defined(__CubeSorting__Fitting__) */
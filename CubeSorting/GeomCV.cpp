@@ -7,18 +7,33 @@
 //
 
 #include "GeomCV.h"
+#include "Viewer.h"
+#include <algorithm>
+#include <cmath>
 
 
 void CallBackFunc(int event, int x, int y, int flags, void* input){
+    Viewer* viewer = (Viewer*)input;
     if(event == cv::EVENT_LBUTTONDOWN){
-        std::cout << "Left click at " << x << ", " << y << std::endl;
-        std::vector<void*>* data = (std::vector<void*>*)input;
-        std::vector<geom::Point2d>* points = (std::vector<geom::Point2d>*)(*data)[0];
-        cv::Mat* image = (cv::Mat*)(*data)[1];
-        points->push_back(geom::Point2d(x,y));
-        cv::circle(*image, cv::Point(x, y), 5, cv::Scalar(255,0,0), -1);
-        imshow("Cube", *image);
+        geom::Point2d p = viewer->toImage(x, y);
+        std::cout << "Left click at " << p.xy[0] << ", " << p.xy[1] << std::endl;
+        viewer->points.push_back(p);
     }
+    else if(event == cv::EVENT_MOUSEWHEEL){
+        viewer->zoomAt(x, y, cv::getMouseWheelDelta(flags) > 0 ? 1.25 : 0.8);
+    }
+    else if(event == cv::EVENT_RBUTTONDOWN){
+        viewer->dragFrom = cv::Point(x, y);
+        return;
+    }
+    else if(event == cv::EVENT_MOUSEMOVE && (flags & cv::EVENT_FLAG_RBUTTON)){
+        viewer->pan(x - viewer->dragFrom.x, y - viewer->dragFrom.y);
+        viewer->dragFrom = cv::Point(x, y);
+    }
+    else{
+        return;
+    }
+    imshow("Cube", viewer->render());
 }
 
 void drawFace(cv::Mat image,
@@ -26,26 +41,37 @@ void drawFace(cv::Mat image,
               geom::Point2d b,
               geom::Point2d c,
               geom::Point2d d,
-              cv::Scalar colour) {
-    cv::line(image, cv::Point(a.xy[0], a.xy[1]), cv::Point(b.xy[0], b.xy[1]), colour, 4);
-    cv::line(image, cv::Point(c.xy[0], c.xy[1]), cv::Point(b.xy[0], b.xy[1]), colour, 4);
-    cv::line(image, cv::Point(c.xy[0], c.xy[1]), cv::Point(d.xy[0], d.xy[1]), colour, 4);
-    cv::line(image, cv::Point(a.xy[0], a.xy[1]), cv::Point(d.xy[0], d.xy[1]), colour, 4);
+              cv::Scalar colour,
+              int thickness) {
+    cv::line(image, cv::Point(a.xy[0], a.xy[1]), cv::Point(b.xy[0], b.xy[1]), colour, thickness);
+    cv::line(image, cv::Point(c.xy[0], c.xy[1]), cv::Point(b.xy[0], b.xy[1]), colour, thickness);
+    cv::line(image, cv::Point(c.xy[0], c.xy[1]), cv::Point(d.xy[0], d.xy[1]), colour, thickness);
+    cv::line(image, cv::Point(a.xy[0], a.xy[1]), cv::Point(d.xy[0], d.xy[1]), colour, thickness);
 }
 
 void drawCube(cv::Mat image, geom::Cube cube){
+    drawCube(image, cube, 1, 1, 1);
+}
+
+void drawCube(cv::Mat image, geom::Cube cube, double scaleX, double scaleY, double lineScale){
     std::vector<geom::Point2d> points = cube.projectPoints();
+    for (auto point = points.begin(); point != points.end(); ++point) {
+        point->xy[0] *= scaleX;
+        point->xy[1] *= scaleY;
+    }
+    // 4 pixels looks right in the default window, so scale from there.
+    int thickness = std::max(1, (int)std::lround(4*lineScale));
     cv::Scalar dark(100,100,100);
     cv::Scalar light(255,255,255);
     
-    drawFace(image, points[1], points[3], points[7], points[5], dark);
-    drawFace(image, points[7], points[6], points[4], points[5], dark);
-    drawFace(image, points[3], points[7], points[6], points[2], dark);
-    drawFace(image, points[0], points[4], points[6], points[2], light);
-    drawFace(image, points[1], points[3], points[2], points[0], light);
-    drawFace(image, points[1], points[5], points[4], points[0], light);
+    drawFace(image, points[1], points[3], points[7], points[5], dark, thickness);
+    drawFace(image, points[7], points[6], points[4], points[5], dark, thickness);
+    drawFace(image, points[3], points[7], points[6], points[2], dark, thickness);
+    drawFace(image, points[0], points[4], points[6], points[2], light, thickness);
+    drawFace(image, points[1], points[3], points[2], points[0], light, thickness);
+    drawFace(image, points[1], points[5], points[4], points[0], light, thickness);
     
     //for (auto point = points.begin(); point != points.end(); ++point) {
     //    cv::circle(image, cv::Point(point->xy[0], point->xy[1]), 5, cv::Scalar(0,255,0), -1);
     //}
-}
\ No newline at end of file
+}
@@ -19,8 +19,16 @@
 #include "Geometry.h"
 
 
+/*
+ Mouse callback for the "Cube" window. input should point to the Viewer being shown. Left click adds a point, the wheel zooms and dragging with the right button pans.
+ */
 void CallBackFunc(int event, int x, int y, int flags, void* input);
 
 void drawCube(cv::Mat image, geom::Cube cube);
 
+/*
+ Draws the cube onto an image which has been resized by scaleX, scaleY from the one the cube was fitted on. Lines are lineScale times as thick as usual, which should be larger for images bigger than the default window.
+ */
+void drawCube(cv::Mat image, geom::Cube cube, double scaleX, double scaleY, double lineScale);
+
 #endif /* defined(__CubeSorting__GeomCV__) */
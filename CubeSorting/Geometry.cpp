@@ -11,57 +11,67 @@
 #include <iostream>
 
 namespace geom {
-    typedef std::vector<double> vec;
     
     /*--- Point member functions ---*/
-    Point3d::Point3d(double x, double y, double z){
+    template<typename T>
+    Point3_<T>::Point3_(T x, T y, T z){
         xyz[0] = x;
         xyz[1] = y;
         xyz[2] = z;
     }
     
-    Point3d Point3d::operator*(double lambda){
-        return Point3d(lambda*this->xyz[0], lambda*this->xyz[1], lambda*this->xyz[2]);
+    template<typename T>
+    Point3_<T> Point3_<T>::operator*(T lambda){
+        return Point3_(lambda*this->xyz[0], lambda*this->xyz[1], lambda*this->xyz[2]);
     }
     
-    Point3d operator*(double lambda, Point3d rhs){
+    template<typename T>
+    Point3_<T> operator*(T lambda, Point3_<T> rhs){
         return rhs*lambda;
     }
     
-    Point2d::Point2d(){
+    template<typename T>
+    Point2_<T>::Point2_(){
         xy[0] = 0;
         xy[1] = 0;
     }
     
-    Point2d::Point2d(double x, double y){
+    template<typename T>
+    Point2_<T>::Point2_(T x, T y){
         xy[0] = x;
         xy[1] = y;
     }
     
-    Point2d Point2d::operator+(Point2d& p){
-        return Point2d(this->xy[0] + p.xy[0], this->xy[1] + p.xy[1]);
+    template<typename T>
+    Point2_<T> Point2_<T>::operator+(Point2_& p){
+        return Point2_(this->xy[0] + p.xy[0], this->xy[1] + p.xy[1]);
     }
     
-    Point2d Point2d::operator-(Point2d& p){
-        return Point2d(this->xy[0] - p.xy[0], this->xy[1] - p.xy[1]);
+    template<typename T>
+    Point2_<T> Point2_<T>::operator-(Point2_& p){
+        return Point2_(this->xy[0] - p.xy[0], this->xy[1] - p.xy[1]);
     }
     
-    Point2d Point2d::operator*(double lambda){
-        return Point2d(lambda*this->xy[0], lambda*this->xy[1]);
+    template<typename T>
+    Point2_<T> Point2_<T>::operator*(T lambda){
+        return Point2_(lambda*this->xy[0], lambda*this->xy[1]);
     }
     
-    double Point2d::operator*(Point2d& p){
+    template<typename T>
+    T Point2_<T>::operator*(Point2_& p){
         return this->xy[0]*p.xy[0] + this->xy[1]*p.xy[1];
     }
     
-    Point2d operator*(double lambda, Point2d rhs){
+    template<typename T>
+    Point2_<T> operator*(T lambda, Point2_<T> rhs){
         return rhs*lambda;
     }
     
     /*--- VirtualGeom member functions ---*/
     
-    Point3d VirtualGeom::_rotate(Point3d p, double theta, int dim){
-        Point3d q = p;
+    template<typename T>
+    Point3_<T> VirtualGeom_<T>::_rotate(Point3_<T> p, T theta, int dim){
+        Point3_<T> q = p;
 
         // Indeces which aren't == dim
         int lowerInd = 0;
@@ -73,38 +83,42 @@ namespace geom {
         }
         
         // Rotation
-        q.xyz[lowerInd] = cos(theta)*p.xyz[lowerInd] - sin(theta)*p.xyz[higherInd];
-        q.xyz[higherInd] = sin(theta)*p.xyz[lowerInd] + cos(theta)*p.xyz[higherInd];
+        q.xyz[lowerInd] = std::cos(theta)*p.xyz[lowerInd] - std::sin(theta)*p.xyz[higherInd];
+        q.xyz[higherInd] = std::sin(theta)*p.xyz[lowerInd] + std::cos(theta)*p.xyz[higherInd];
         return q;
     }
     
-    Point3d VirtualGeom::_rotate(Point3d p, vec theta){
-        Point3d q = p;
+    template<typename T>
+    Point3_<T> VirtualGeom_<T>::_rotate(Point3_<T> p, std::vector<T> theta){
+        Point3_<T> q = p;
         for (int i = 2; i >= 0; --i) {
             q = _rotate(q, theta[i], i);
         }
         return q;
     }
     
-    Point2d VirtualGeom::_project(Point3d p, double cameraDist){
-        Point2d v(p.xyz[1], p.xyz[2]);
-        double lambda = (-cameraDist/10)/(p.xyz[0] - cameraDist);
+    template<typename T>
+    Point2_<T> VirtualGeom_<T>::_project(Point3_<T> p, T cameraDist){
+        Point2_<T> v(p.xyz[1], p.xyz[2]);
+        T lambda = (-cameraDist/10)/(p.xyz[0] - cameraDist);
         v = lambda*v;
         return v;
     }
     
-    Point2d VirtualGeom::_rotateThenProject(Point3d p,
-                                            vec theta,
-                                            double cameraDist){
+    template<typename T>
+    Point2_<T> VirtualGeom_<T>::_rotateThenProject(Point3_<T> p,
+                                                   std::vector<T> theta,
+                                                   T cameraDist){
         p = _rotate(p, theta);
         return _project(p, cameraDist);
     }
     
-    void VirtualGeom::_extractParams(vec params,
-                                     vec &theta,
-                                     double &cameraDist,
-                                     double &scale,
-                                     geom::Point2d &p){
+    template<typename T>
+    void VirtualGeom_<T>::_extractParams(std::vector<T> params,
+                                         std::vector<T> &theta,
+                                         T &cameraDist,
+                                         T &scale,
+                                         Point2_<T> &p){
         theta = {params[0], params[1], params[2]};
         cameraDist = params[3];
         scale = params[4];
@@ -113,70 +127,95 @@ namespace geom {
     }
     
     /*--- Objective member functions ---*/
-    Objective::Objective(std::vector<Point2d> userInput)
+    template<typename T>
+    Objective_<T>::Objective_(std::vector<Point2_<T>> userInput)
     : _observedPoints(userInput) {
-        _vertices.push_back(Point3d(0, 0, 0));
-        _vertices.push_back(Point3d(1, 1, 0));
-        _vertices.push_back(Point3d(1, 0, 0));
-        _vertices.push_back(Point3d(1, 0, 1));
-        _vertices.push_back(Point3d(0, 0, 1));
-        _vertices.push_back(Point3d(0, 1, 1));
-        _vertices.push_back(Point3d(0, 1, 0));
-    }
-    
-    double Objective::operator()(vec params){
-        double sum = 0;
+        _vertices.push_back(Point3_<T>(0, 0, 0));
+        _vertices.push_back(Point3_<T>(1, 1, 0));
+        _vertices.push_back(Point3_<T>(1, 0, 0));
+        _vertices.push_back(Point3_<T>(1, 0, 1));
+        _vertices.push_back(Point3_<T>(0, 0, 1));
+        _vertices.push_back(Point3_<T>(0, 1, 1));
+        _vertices.push_back(Point3_<T>(0, 1, 0));
+    }
+    
+    template<typename T>
+    T Objective_<T>::operator()(std::vector<T> params){
+        T sum = 0;
         for (int i = 0; i < _observedPoints.size(); ++i) {
             sum += _squaredDist(i, params);
         }
         return sum;
     }
     
-    double Objective::_squaredDist(int vertIndex, vec params){
-        vec theta;
-        double cameraDist;
-        double scale;
-        Point2d p;
-        _extractParams(params, theta, cameraDist, scale, p);
-        Point2d v = _rotateThenProject(_vertices[vertIndex],
-                                       theta,
-                                       cameraDist);
+    template<typename T>
+    T Objective_<T>::_squaredDist(int vertIndex, std::vector<T> params){
+        std::vector<T> theta;
+        T cameraDist;
+        T scale;
+        Point2_<T> p;
+        this->_extractParams(params, theta, cameraDist, scale, p);
+        Point2_<T> v = this->_rotateThenProject(_vertices[vertIndex],
+                                                theta,
+                                                cameraDist);
         v = scale*v + p;
-        Point2d difference = v - _observedPoints[vertIndex];
+        Point2_<T> difference = v - _observedPoints[vertIndex];
         return difference*difference;
     }
     
     
     /*--- Cube member functions ---*/
-    Cube::Cube(vec params)
+    template<typename T>
+    Cube_<T>::Cube_(std::vector<T> params)
     :params(params) {
-        _extractParams(params, theta, cameraDist, scale, centre);
+        this->_extractParams(params, theta, cameraDist, scale, centre);
         vertices = _generateVertices();
         for (auto it = vertices.begin(); it != vertices.end(); ++it) {
-            projected.push_back(scale*_project((*it), cameraDist) + centre);
+            projected.push_back(scale*this->_project((*it), cameraDist) + centre);
         }
     }
     
-    std::vector<Point2d> Cube::projectPoints(){
+    template<typename T>
+    std::vector<Point2_<T>> Cube_<T>::projectPoints(){
         return projected;
     }
     
-    vec Cube::getParams(){
+    template<typename T>
+    std::vector<T> Cube_<T>::getParams(){
         return params;
     }
     
-    std::vector<Point3d> Cube::_generateVertices(){
-        std::vector<Point3d> verts;
-        for (double x = 0; x < 2; ++x) {
-            for (double y = 0; y < 2; ++y) {
-                for (double z = 0; z < 2; ++z) {
-                    verts.push_back(_rotate(Point3d(x,y,z), theta));
+    template<typename T>
+    std::vector<Point3_<T>> Cube_<T>::_generateVertices(){
+        std::vector<Point3_<T>> verts;
+        for (T x = 0; x < 2; ++x) {
+            for (T y = 0; y < 2; ++y) {
+                for (T z = 0; z < 2; ++z) {
+                    verts.push_back(this->_rotate(Point3_<T>(x,y,z), theta));
                 }
             }
         }
         return verts;
     }
     
+    /*--- Explicit instantiations ---*/
+    template struct Point3_<float>;
+    template struct Point3_<double>;
+    template Point3_<float> operator*(float lambda, Point3_<float> rhs);
+    template Point3_<double> operator*(double lambda, Point3_<double> rhs);
+    
+    template struct Point2_<float>;
+    template struct Point2_<double>;
+    template Point2_<float> operator*(float lambda, Point2_<float> rhs);
+    template Point2_<double> operator*(double lambda, Point2_<double> rhs);
+    
+    template class VirtualGeom_<float>;
+    template class VirtualGeom_<double>;
+    template class Objective_<float>;
+    template class Objective_<double>;
+    template class Cube_<float>;
+    template class Cube_<double>;
+    
 }  // namespace geom
 
 
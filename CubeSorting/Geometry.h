@@ -15,30 +15,44 @@
 namespace geom {
     typedef std::vector<double> vec;
     
-    struct Point3d{
-        Point3d(double x, double y, double z);
-        double xyz[3];
-        Point3d operator*(double lambda);
+    /*
+     Everything below is generic over the scalar type T, and is explicitly instantiated for float and double in Geometry.cpp. Double is the default throughout; the typedefs without a suffix are the double versions. Float still fits to well under a pixel, but as the kernels are scalar it is no faster than double (see the -b benchmark).
+     */
+    
+    template<typename T>
+    struct Point3_{
+        Point3_(T x, T y, T z);
+        T xyz[3];
+        Point3_ operator*(T lambda);
     };
     
-    Point3d operator*(double lambda, Point3d rhs);
+    template<typename T>
+    Point3_<T> operator*(T lambda, Point3_<T> rhs);
     
-    struct Point2d{
-        Point2d();  // Constructs the point (0,0)
-        Point2d(double x, double y);
-        double xy[2];
-        Point2d operator+(Point2d& p);
-        Point2d operator-(Point2d& p);
-        Point2d operator*(double lambda);
-        double operator*(Point2d& p);  // Dot product
+    template<typename T>
+    struct Point2_{
+        Point2_();  // Constructs the point (0,0)
+        Point2_(T x, T y);
+        T xy[2];
+        Point2_ operator+(Point2_& p);
+        Point2_ operator-(Point2_& p);
+        Point2_ operator*(T lambda);
+        T operator*(Point2_& p);  // Dot product
     };
     
-    Point2d operator*(double lambda, Point2d rhs);
+    template<typename T>
+    Point2_<T> operator*(T lambda, Point2_<T> rhs);
+    
+    typedef Point3_<double> Point3d;
+    typedef Point3_<float> Point3f;
+    typedef Point2_<double> Point2d;
+    typedef Point2_<float> Point2f;
     
     /*
-     Not intended to be created on its own. Inherited by Objective and Cube objects.
+     Not intended to be created on its own. Inherited by Objective_ and Cube_ objects.
      */
-    class VirtualGeom {
+    template<typename T>
+    class VirtualGeom_ {
     protected:
         /*
          Returns the point p rotated by angle theta around dimension dim.
@@ -47,29 +61,29 @@ namespace geom {
            1 = y
            2 = z
          */
-        Point3d _rotate(Point3d p,
-                        double theta,  // theta in radians
-                        int dim);
+        Point3_<T> _rotate(Point3_<T> p,
+                           T theta,  // theta in radians
+                           int dim);
         
         /*
          Returns the point p rotated by angle theta around the z, y then x axes. Theta should be taken as representing
                  theta = {th_x, th_y, th_z}
          */
-        Point3d _rotate(Point3d p,
-                        vec theta);
+        Point3_<T> _rotate(Point3_<T> p,
+                           std::vector<T> theta);
         /*
          Projects the point p onto a plane orthogonal to the x-axis. This is done by drawing a straight line joining the point p and the x-axis at cameraDist. The plane is taken to be a fixed amount in front of the camera (currently 1). Usually, cameraDist is taken as negative.
          */
-        Point2d _project(Point3d p,
-                         double cameraDist);
+        Point2_<T> _project(Point3_<T> p,
+                            T cameraDist);
         /* 
          Rotates the point p through angles theta around the z, y, then x axes. Then projects the point using the function above. Theta should still be taken as representing
                  theta = {th_x, th_y, th_z},
              the rotations around the x, y, and z axes respectively.
          */
-        Point2d _rotateThenProject(Point3d p,
-                                   vec theta,
-                                   double cameraDist);
+        Point2_<T> _rotateThenProject(Point3_<T> p,
+                                      std::vector<T> theta,
+                                      T cameraDist);
         
         /* 
          Takes in a parameter vector and assigns the parts to theta, cameraDist, scale and p. All but params get changed by calling the function. 
@@ -77,34 +91,38 @@ namespace geom {
          Params should represent
              (thetaX, thetaY, thetaZ, cameraDist, scale, centreX, centreY)
          */
-        void _extractParams(vec params,
-                            vec& theta,
-                            double& cameraDist,
-                            double& scale,
-                            Point2d& p);
+        void _extractParams(std::vector<T> params,
+                            std::vector<T>& theta,
+                            T& cameraDist,
+                            T& scale,
+                            Point2_<T>& p);
     };
     
     /*
      Function object to find the most suitable parameters to fit a cube to user input.
      
-     Construct functor with a vector<double> (of length 7) representing user input. The order needs to be be: "central" vertex, top vertex, then around the others in anti-clockwise order. Recall that the y-axis is going down (because in an image), so the top vertex is the one seen with the smallest y-value.
+     Construct functor with a vector<Point2_<T>> (of length 7) representing user input. The order needs to be be: "central" vertex, top vertex, then around the others in anti-clockwise order. Recall that the y-axis is going down (because in an image), so the top vertex is the one seen with the smallest y-value.
      
-     The operator() takes a vector<double> of parameters representing:
+     The operator() takes a vector<T> of parameters representing:
         (thetaX, thetaY, thetaZ, cameraDist, scale, centreX, centreY)
      */
-    class Objective : VirtualGeom {
+    template<typename T>
+    class Objective_ : VirtualGeom_<T> {
     public:
         /*
          Takes in user input. Vector should have length 7. Also constructs the vector of visible vertices in the correct order.
          */
-        Objective(std::vector<Point2d> userInput);
-        double operator()(vec params);
+        Objective_(std::vector<Point2_<T>> userInput);
+        T operator()(std::vector<T> params);
     private:
-        double _squaredDist(int vertIndex, vec params);
-        std::vector<Point2d> _observedPoints;
-        std::vector<Point3d> _vertices;
+        T _squaredDist(int vertIndex, std::vector<T> params);
+        std::vector<Point2_<T>> _observedPoints;
+        std::vector<Point3_<T>> _vertices;
     };
     
+    typedef Objective_<double> Objective;
+    typedef Objective_<float> Objectivef;
+    
     /*
      Represents a cube. Hence the name.
      
@@ -112,27 +130,31 @@ namespace geom {
         (thetaX, thetaY, thetaZ, cameraDist, scale, centreX, centreY)
      It should work with the output of gradientDescent on an Objective function object.
      */
-    class Cube : VirtualGeom {
+    template<typename T>
+    class Cube_ : VirtualGeom_<T> {
     public:
-        Cube(vec params);
-        std::vector<Point2d> projectPoints();
-        vec getParams();
+        Cube_(std::vector<T> params);
+        std::vector<Point2_<T>> projectPoints();
+        std::vector<T> getParams();
     private:
         /*
          Returns rotated, but not scaled, vertices of the cube. Vertices are the images of those of the unit cube. The order of vertices corresponds to the binary representation of their coordinate. For example, 
                  vertex[3] is the image of (0,1,1), 
                  because 011 bin = 3 dec.
          */
-        std::vector<Point3d> _generateVertices();
-        vec params;
-        vec theta;
-        double cameraDist;
-        double scale;
-        Point2d centre;
-        std::vector<Point2d> projected;
-        std::vector<Point3d> vertices;
+        std::vector<Point3_<T>> _generateVertices();
+        std::vector<T> params;
+        std::vector<T> theta;
+        T cameraDist;
+        T scale;
+        Point2_<T> centre;
+        std::vector<Point2_<T>> projected;
+        std::vector<Point3_<T>> vertices;
     };
     
+    typedef Cube_<double> Cube;
+    typedef Cube_<float> Cubef;
+    
 } // namespace geom
 
 #endif /* defined(__CubeSorting__Geometry__) */
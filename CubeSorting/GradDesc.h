@@ -10,17 +10,26 @@
 #define __CubeSorting__GradDesc__
 
 #include <stdio.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
 #include <vector>
 
 namespace gd{
     
     typedef std::vector<double> vec;
     
+    /*
+     The functions below are generic over the scalar type T, so that they can descend either an Objective or an Objectivef. T is deduced from the vectors passed in.
+     */
+    
     /*
      Computes the dot product of two vectors
      */
-    double dot(std::vector<double> v, std::vector<double> w){
-        double sum = 0;
+    template<typename T>
+    T dot(std::vector<T> v, std::vector<T> w){
+        T sum = 0;
         for (int i = 0; i < v.size(); ++i) {
             sum += v[i]*w[i];
         }
@@ -30,9 +39,10 @@ namespace gd{
     /*
      Computes the squared Euclidean distance between v and w.
      */
-    double distSq(std::vector<double> v, std::vector<double> w){
-        double dist = 0;
-        double dElem; // temp variable to hold element differences in loop
+    template<typename T>
+    T distSq(std::vector<T> v, std::vector<T> w){
+        T dist = 0;
+        T dElem; // temp variable to hold element differences in loop
         for (int i = 0; i < v.size(); ++i) {
             dElem = v[i] - w[i];
             dist += dElem*dElem;
@@ -45,18 +55,22 @@ namespace gd{
     
     /*
      Numerically calculates the gradient of the function at the position theta.
+     
+     The step is 0.0001, unless that is lost in rounding at the size of theta[i]. That only happens with float, where the step grows with theta[i] instead.
      */
-    template<typename Functor>
-    std::vector<double> findGradient(Functor F, std::vector<double> theta){
-        double dTheta = 0.0001; // Smaller -> better approximation
-        double value = F(theta);
-        vec newTheta = theta;
-        double dValue;
-        vec gradient = theta;
+    template<typename Functor, typename T>
+    std::vector<T> findGradient(Functor F, std::vector<T> theta){
+        T relStep = std::sqrt(std::numeric_limits<T>::epsilon());
+        T value = F(theta);
+        std::vector<T> newTheta = theta;
+        T dTheta; // Smaller -> better approximation
+        T dValue;
+        std::vector<T> gradient = theta;
         for (int i = 0; i < theta.size(); ++i) {
+            dTheta = std::max(T(0.0001), relStep*std::abs(theta[i]));
             newTheta[i] = theta[i] + dTheta;
             dValue = F(newTheta) - value;
-            gradient[i] = dValue/dTheta;
+            gradient[i] = dValue/(newTheta[i] - theta[i]);
             newTheta[i] = theta[i];
         }
         return gradient;
@@ -72,19 +86,48 @@ namespace gd{
      rate     - multiplier of gradient. How far we step.
      Output: vector which is an update of theta
      */
-    template<typename Functor>
-    std::vector<double> stepDown(Functor F,
-                                 std::vector<double> theta,
-                                 std::vector<double> rate,
-                                 std::vector<double>& grad){
+    template<typename Functor, typename T>
+    std::vector<T> stepDown(Functor F,
+                            std::vector<T> theta,
+                            std::vector<T> rate,
+                            std::vector<T>& grad){
         grad = findGradient<Functor>(F, theta);
-        vec newTheta = theta;
+        std::vector<T> newTheta = theta;
         for (int i = 0; i < theta.size(); i++) {
             newTheta[i] -= rate[i]*grad[i];
         }
         return newTheta;
     }
-
+    
+    
+    
+    /*
+     Carries on gradient descent from theta for at most maxSteps more steps, updating theta in place. iterations is the number of steps taken so far, and is updated too, so that a long descent can be split up into several calls.
+     Input: function  - the function to be optimised
+     theta            - where to carry on from; updated to the new position
+     rate             - learning rate, as for gradientDescent
+     tol              - as for gradientDescent
+     maxSteps         - the most steps to take in this call
+     iterations       - steps taken by previous calls (start from 0)
+     Output: true once descent has finished, either because the gradient is below tol or because 10000 steps have been taken in total
+     */
+    template<typename Functor, typename T>
+    bool continueDescent(Functor F,
+                         std::vector<T>& theta,
+                         std::vector<T> rate,
+                         double tol,
+                         int maxSteps,
+                         int& iterations){
+        std::vector<T> grad = theta;
+        for (int step = 0; step < maxSteps; ++step) {
+            ++iterations;
+            theta = stepDown<Functor>(F, theta, rate, grad);
+            if (dot(grad,grad) < tol || iterations > 10000) {
+                return true;
+            }
+        }
+        return false;
+    }
     
     
     /*
@@ -93,27 +136,22 @@ namespace gd{
      init             - initial guess for argument of function
      rate             - learning rate: gradient multiplied by this to give different descent rate
      tol              - how small the change in theta needs to be before alg can terminate
+     verbose          - whether to report the number of iterations on stdout
      Output: vector which satisfies argmin(function)
      */
-    template<typename Functor>
-    std::vector<double> gradientDescent(Functor F,
-                                        std::vector<double> init,
-                                        std::vector<double> rate,
-                                        double tol){
-        vec oldTheta = init;
-        vec theta = init;
-        vec grad = init;
+    template<typename Functor, typename T>
+    std::vector<T> gradientDescent(Functor F,
+                                   std::vector<T> init,
+                                   std::vector<T> rate,
+                                   double tol,
+                                   bool verbose = true){
+        std::vector<T> theta = init;
         int i = 0;
-        cv::Mat temp;
-        while (true) {
-            ++i;
-            theta = stepDown<Functor>(F, oldTheta, rate, grad);
-            oldTheta = theta;
-            if (dot(grad,grad) < tol | i > 10000) {
-                break;
-            }
+        while (!continueDescent<Functor>(F, theta, rate, tol, 10000, i)) {
+        }
+        if (verbose) {
+            std::cout << "Gradient descent terminated in " << i << " iterations." << std::endl;
         }
-        std::cout << "Gradient descent terminated in " << i << " iterations." << std::endl;
         return theta;
     }
     
@@ -0,0 +1,205 @@
+//
+//  Render.cpp
+//  CubeSorting
+//
+//  Created by agent on 19/10/2026.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "Render.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <opencv2/core/core.hpp>
+#include <opencv2/highgui/highgui.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "GeomCV.h"
+
+/*
+ Calls job(0), ..., job(n-1) spread over one thread per core. Each thread takes the next unclaimed index when it finishes its last, so slow images don't hold up the rest.
+ */
+template<typename Job>
+void parallelFor(int n, Job job){
+    std::atomic<int> next(0);
+    int nThreads = std::max(1, (int)std::thread::hardware_concurrency());
+    std::vector<std::thread> workers;
+    for (int t = 0; t < std::min(nThreads, n); ++t) {
+        workers.push_back(std::thread([&]() {
+            for (int i = next++; i < n; i = next++) {
+                job(i);
+            }
+        }));
+    }
+    for (auto it = workers.begin(); it != workers.end(); ++it) {
+        it->join();
+    }
+}
+
+
+/*
+ Parses one two line record of out.csv. Returns false if it is malformed.
+ */
+bool parseFit(std::string pointsLine, std::string paramsLine, int& image, geom::vec& params){
+    const int nParams = 7;  // as for geom::Cube
+    try {
+        size_t end;
+        std::string number = pointsLine.substr(0, pointsLine.find(','));
+        image = std::stoi(number, &end);
+        if (number.find_first_not_of(" \t", end) != std::string::npos) {
+            return false;
+        }
+        std::stringstream ss(paramsLine);
+        std::string field;
+        std::getline(ss, field, ',');
+        if (!field.empty()) {
+            return false;  // parameter lines start with a comma
+        }
+        params.clear();
+        while (std::getline(ss, field, ',')) {
+            params.push_back(std::stod(field, &end));
+            if (field.find_first_not_of(" \t\r", end) != std::string::npos) {
+                return false;
+            }
+        }
+    } catch (std::logic_error&) {
+        return false;  // std::invalid_argument or std::out_of_range from stoi/stod
+    }
+    return params.size() == nParams;
+}
+
+bool readFits(std::string fileName,
+              std::map<int, std::vector<geom::vec>>& fits,
+              bool& fullResolution){
+    std::ifstream input(fileName);
+    if (!input) {
+        return false;
+    }
+    std::string pointsLine;
+    std::string paramsLine;
+    int lineNumber = 0;
+    
+    fullResolution = input.peek() == '#';
+    if (fullResolution) {
+        std::getline(input, pointsLine);
+        ++lineNumber;
+        fullResolution = pointsLine == fullResolutionHeader;
+    }
+    
+    // Each record is two lines: "n,x y,x y,..." then ",p0,p1,...".
+    while (std::getline(input, pointsLine)) {
+        ++lineNumber;
+        if (pointsLine.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        if (pointsLine[0] == ',') {
+            // A parameters line without its points line; carry on from the next record.
+            std::cout << "Skipping line " << lineNumber << " of " << fileName << ": no points line before it" << std::endl;
+            continue;
+        }
+        if (!std::getline(input, paramsLine)) {
+            std::cout << "Skipping line " << lineNumber << " of " << fileName << ": record has no parameters line" << std::endl;
+            break;
+        }
+        ++lineNumber;
+        int image;
+        geom::vec params;
+        if (!parseFit(pointsLine, paramsLine, image, params)) {
+            std::cout << "Skipping lines " << lineNumber - 1 << "-" << lineNumber << " of " << fileName
+                      << ": expected an image number and 7 parameters" << std::endl;
+            continue;
+        }
+        fits[image].push_back(params);
+    }
+    return true;
+}
+
+
+int renderOverlays(const std::map<int, std::vector<geom::vec>>& fits,
+                   std::string inputDirectory,
+                   std::string outputDirectory,
+                   int fitWidth,
+                   int fitHeight){
+    std::vector<int> images;
+    for (auto it = fits.begin(); it != fits.end(); ++it) {
+        images.push_back(it->first);
+    }
+    
+    std::atomic<int> written(0);
+    parallelFor((int)images.size(), [&](int i) {
+        int n = images[i];
+        cv::Mat image = cv::imread(inputDirectory + std::to_string(n) + ".jpg");
+        if (! image.data) {
+            std::cout << "Error loading image " << n << std::endl;
+            return;
+        }
+        double scaleX = fitWidth > 0 ? (double)image.cols/fitWidth : 1;
+        double scaleY = fitHeight > 0 ? (double)image.rows/fitHeight : 1;
+        // Scale the lines up with the image, from their size in the default window.
+        double lineScale = std::max(image.cols/480.0, image.rows/640.0);
+        const std::vector<geom::vec>& cubes = fits.at(n);
+        for (auto params = cubes.begin(); params != cubes.end(); ++params) {
+            drawCube(image, geom::Cube(*params), scaleX, scaleY, lineScale);
+        }
+        if (cv::imwrite(outputDirectory + std::to_string(n) + "_overlay.jpg", image)) {
+            ++written;
+        }
+    });
+    return written;
+}
+
+
+int renderContactSheets(const std::map<int, std::vector<geom::vec>>& fits,
+                        std::string inputDirectory,
+                        std::string outputDirectory,
+                        int fitWidth,
+                        int fitHeight,
+                        int tileWidth,
+                        int tileHeight,
+                        int columns){
+    std::vector<int> images;
+    for (auto it = fits.begin(); it != fits.end(); ++it) {
+        images.push_back(it->first);
+    }
+    
+    int tilesPerSheet = columns*columns;
+    int nSheets = 0;
+    cv::Mat sheet(columns*tileHeight, columns*tileWidth, CV_8UC3);
+    for (int first = 0; first < images.size(); first += tilesPerSheet) {
+        int nTiles = std::min(tilesPerSheet, (int)images.size() - first);
+        sheet.setTo(cv::Scalar(0,0,0));
+        
+        // Tiles cover disjoint parts of the sheet, so can be drawn concurrently.
+        parallelFor(nTiles, [&](int t) {
+            int n = images[first + t];
+            cv::Mat tile = sheet(cv::Rect((t % columns)*tileWidth,
+                                          (t / columns)*tileHeight,
+                                          tileWidth,
+                                          tileHeight));
+            cv::Mat image = cv::imread(inputDirectory + std::to_string(n) + ".jpg");
+            if (! image.data) {
+                std::cout << "Error loading image " << n << std::endl;
+                return;
+            }
+            double scaleX = (double)tileWidth/(fitWidth > 0 ? fitWidth : image.cols);
+            double scaleY = (double)tileHeight/(fitHeight > 0 ? fitHeight : image.rows);
+            cv::resize(image, tile, tile.size(), 0, 0, cv::INTER_AREA);
+            const std::vector<geom::vec>& cubes = fits.at(n);
+            for (auto params = cubes.begin(); params != cubes.end(); ++params) {
+                drawCube(tile, geom::Cube(*params), scaleX, scaleY,
+                         std::sqrt(tileWidth*tileHeight/(480.0*640.0)));
+            }
+            cv::putText(tile, std::to_string(n), cv::Point(5, 20),
+                        cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(0,255,255), 2);
+        });
+        
+        cv::imwrite(outputDirectory + "sheet_" + std::to_string(nSheets) + ".jpg", sheet);
+        ++nSheets;
+    }
+    return nSheets;
+}
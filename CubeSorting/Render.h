@@ -0,0 +1,62 @@
+//
+//  Render.h
+//  CubeSorting
+//
+//  Created by agent on 19/10/2026.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#ifndef __CubeSorting__Render__
+#define __CubeSorting__Render__
+
+#include <stdio.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Geometry.h"
+
+/*
+ Headless rendering of fitted cubes, for checking fits without stepping through the GUI.
+ 
+ Fits are read back from the out.csv written by the interactive mode and drawn over the original images, which are expected to be named <n>.jpg in the input directory as usual.
+ 
+ Files written since the zoomable viewer was added start with the line fullResolutionHeader, and their fits are in the images' full resolution coordinates. Older files have no header line. Their fits are in the coordinates of the image resized to the -w x -h it was clicked on, so the renderers take that fitting frame as fitWidth x fitHeight.
+ */
+
+// First line of out.csv files with fits in full resolution coordinates.
+const std::string fullResolutionHeader = "# CubeSorting fits: full resolution";
+
+/*
+ Reads out.csv into fits, which gets the parameters of every cube keyed by image number. An image with several cubes has several entries. fullResolution is set to whether the file has the full resolution header. Malformed records are skipped with a warning. Returns false if the file can't be opened.
+ */
+bool readFits(std::string fileName,
+              std::map<int, std::vector<geom::vec>>& fits,
+              bool& fullResolution);
+
+/*
+ Writes <n>_overlay.jpg to outputDirectory for every image with a fit, drawn at the image's full resolution. The fits were made on the image resized to fitWidth x fitHeight, or on the full resolution image if those are 0. Images are processed in parallel, but each worker holds at most one image at a time.
+ 
+ Returns the number of overlays written.
+ */
+int renderOverlays(const std::map<int, std::vector<geom::vec>>& fits,
+                   std::string inputDirectory,
+                   std::string outputDirectory,
+                   int fitWidth,
+                   int fitHeight);
+
+/*
+ Writes contact sheets sheet_<k>.jpg to outputDirectory, each a grid of columns x columns tiles of size tileWidth x tileHeight, labelled with the image number. fitWidth and fitHeight are as for renderOverlays. Sheets are built one at a time and their tiles are filled in parallel, so at most one sheet is held in memory.
+ 
+ Returns the number of sheets written.
+ */
+int renderContactSheets(const std::map<int, std::vector<geom::vec>>& fits,
+                        std::string inputDirectory,
+                        std::string outputDirectory,
+                        int fitWidth,
+                        int fitHeight,
+                        int tileWidth,
+                        int tileHeight,
+                        int columns);
+
+#endif /* defined(__CubeSorting__Render__) */
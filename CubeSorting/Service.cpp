@@ -0,0 +1,307 @@
+//
+//  Service.cpp
+//  CubeSorting
+//
+//  Created by agent on 19/10/2026.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "Service.h"
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <csignal>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+/*--- FitService member functions ---*/
+FitService::FitService(int nWorkers, int maxBatch)
+: _nWorkers(nWorkers), _maxBatch(maxBatch), _stopping(false) {
+    for (int i = 0; i < nWorkers; ++i) {
+        _workers.push_back(std::thread(&FitService::_work, this));
+    }
+}
+
+FitService::~FitService(){
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _ready.notify_all();
+    for (auto it = _workers.begin(); it != _workers.end(); ++it) {
+        it->join();
+    }
+}
+
+std::future<std::string> FitService::submit(std::string request){
+    Job job;
+    std::future<std::string> response = job.response.get_future();
+    std::string error = parseRequest(request, job.id, job.width, job.height, job.points);
+    if (error != "") {
+        job.response.set_value(job.id + " error " + error);
+        return response;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _queue.push_back(std::move(job));
+    }
+    _ready.notify_one();
+    return response;
+}
+
+void FitService::_work(){
+    std::vector<Job> batch;
+    while (true) {
+        bool more;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _ready.wait(lock, [this]() { return _stopping || !_queue.empty(); });
+            if (_queue.empty()) {
+                return;  // stopping, and nothing left to do
+            }
+            // Take a fair share, so one worker doesn't sit on a burst while the rest are idle.
+            size_t share = (_queue.size() + _nWorkers - 1)/_nWorkers;
+            size_t take = std::min(share, (size_t)_maxBatch);
+            while (batch.size() < take) {
+                batch.push_back(std::move(_queue.front()));
+                _queue.pop_front();
+            }
+            more = !_queue.empty();
+        }
+        if (more) {
+            _ready.notify_one();
+        }
+        for (auto job = batch.begin(); job != batch.end(); ++job) {
+            geom::vec params = geom::fitCube<double>(job->points, job->width, job->height, false);
+            job->response.set_value(formatResponse(job->id, job->points, params));
+        }
+        batch.clear();
+    }
+}
+
+
+/*--- Request handling ---*/
+std::string parseRequest(std::string request,
+                         std::string& id,
+                         double& width,
+                         double& height,
+                         std::vector<geom::Point2d>& points){
+    std::stringstream ss(request);
+    ss >> id >> width >> height;
+    
+    double x, y;
+    while (points.size() < geom::pointsPerCube && ss >> x >> y) {
+        points.push_back(geom::Point2d(x, y));
+    }
+    if (!ss || points.size() != geom::pointsPerCube) {
+        return "expected: id width height followed by 7 points";
+    }
+    if (width <= 0 || height <= 0) {
+        return "width and height must be positive";
+    }
+    std::string extra;
+    if (ss >> extra) {
+        return "unexpected fields after the 7th point";
+    }
+    return "";
+}
+
+std::string formatResponse(std::string id,
+                           std::vector<geom::Point2d> points,
+                           geom::vec params){
+    geom::Objective F(points);
+    double rms = std::sqrt(F(params)/geom::pointsPerCube);
+    
+    std::stringstream response;
+    response.precision(10);
+    response << id;
+    for (int i = 0; i < params.size(); ++i) {
+        response << " " << params[i];
+    }
+    response << " " << rms;
+    return response.str();
+}
+
+
+/*--- Connections ---*/
+
+/*
+ Writes all of line to fd. Returns false if the other end has gone away.
+ */
+bool writeLine(int fd, std::string line){
+    line += "\n";
+    const char* data = line.c_str();
+    size_t left = line.size();
+    while (left > 0) {
+        ssize_t n = write(fd, data, left);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        left -= n;
+    }
+    return true;
+}
+
+/*
+ A response which is already known, for requests which never reach the workers.
+ */
+std::future<std::string> readyResponse(std::string line){
+    std::promise<std::string> response;
+    response.set_value(line);
+    return response.get_future();
+}
+
+/*
+ The error response to a line longer than maxRequestLength, keeping its id if there is one.
+ */
+std::future<std::string> tooLongResponse(std::string line){
+    std::string id;
+    std::stringstream(line.substr(0, maxRequestLength)) >> id;
+    return readyResponse(id + " error request longer than " + std::to_string(maxRequestLength) + " characters");
+}
+
+void serveConnection(FitService& service, int inFd, int outFd){
+    // Responses waiting to be written, in request order.
+    std::deque<std::future<std::string>> pending;
+    std::mutex mutex;
+    std::condition_variable ready;  // something to write, or reading has finished
+    std::condition_variable space;  // room in pending
+    bool finished = false;
+    
+    std::thread writer([&]() {
+        bool open = true;
+        while (true) {
+            std::future<std::string> response;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [&]() { return finished || !pending.empty(); });
+                if (pending.empty()) {
+                    return;
+                }
+                response = std::move(pending.front());
+                pending.pop_front();
+            }
+            space.notify_one();
+            // Always wait for the fit, so nothing outlives this connection.
+            std::string line = response.get();
+            if (open) {
+                open = writeLine(outFd, line);
+            }
+        }
+    });
+    
+    // Waits for room, so a client which doesn't read its responses stops being read from.
+    auto queue = [&](std::future<std::string> response) {
+        std::unique_lock<std::mutex> lock(mutex);
+        space.wait(lock, [&]() { return pending.size() < maxPendingRequests; });
+        pending.push_back(std::move(response));
+        ready.notify_one();
+    };
+    
+    std::string buffer;
+    bool discarding = false;  // in the middle of a line which was too long
+    char chunk[4096];
+    while (true) {
+        ssize_t n = read(inFd, chunk, sizeof(chunk));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        buffer.append(chunk, n);
+        
+        size_t start = 0;
+        size_t end;
+        while ((end = buffer.find('\n', start)) != std::string::npos) {
+            std::string request = buffer.substr(start, end - start);
+            start = end + 1;
+            if (discarding) {
+                discarding = false;  // the end of a line already answered
+                continue;
+            }
+            if (request.size() > maxRequestLength) {
+                queue(tooLongResponse(request));
+                continue;
+            }
+            if (request.find_first_not_of(" \t\r") == std::string::npos) {
+                continue;  // skip blank lines
+            }
+            queue(service.submit(request));
+        }
+        buffer.erase(0, start);
+        
+        if (buffer.size() > maxRequestLength) {
+            // Answer it now and drop the rest, rather than buffering a line with no end.
+            if (!discarding) {
+                queue(tooLongResponse(buffer));
+                discarding = true;
+            }
+            buffer.clear();
+        }
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished = true;
+    }
+    ready.notify_one();
+    writer.join();
+}
+
+int serveSocket(FitService& service, std::string path){
+    // Clients hanging up early shouldn't take the whole service down.
+    std::signal(SIGPIPE, SIG_IGN);
+    
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Socket path too long: " << path << std::endl;
+        return 1;
+    }
+    std::strcpy(address.sun_path, path.c_str());
+    
+    // Clear away a socket left behind by an earlier run, but nothing else.
+    struct stat existing;
+    if (lstat(path.c_str(), &existing) == 0) {
+        if (!S_ISSOCK(existing.st_mode)) {
+            std::cerr << "Not replacing " << path << ": it exists and isn't a socket" << std::endl;
+            return 1;
+        }
+        unlink(path.c_str());
+    }
+    
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0
+        || bind(listener, (sockaddr*)&address, sizeof(address)) < 0
+        || listen(listener, SOMAXCONN) < 0) {
+        std::cerr << "Could not listen on " << path << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    std::cerr << "Listening on " << path << std::endl;
+    
+    while (true) {
+        int connection = accept(listener, NULL, NULL);
+        if (connection < 0) {
+            if (errno != EINTR && errno != ECONNABORTED) {
+                // Probably out of file descriptors; give connections a chance to close.
+                std::cerr << "accept failed: " << std::strerror(errno) << std::endl;
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+            continue;
+        }
+        std::thread([&service, connection]() {
+            serveConnection(service, connection, connection);
+            close(connection);
+        }).detach();
+    }
+}
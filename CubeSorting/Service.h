@@ -0,0 +1,96 @@
+//
+//  Service.h
+//  CubeSorting
+//
+//  Created by agent on 19/10/2026.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#ifndef __CubeSorting__Service__
+#define __CubeSorting__Service__
+
+#include <stdio.h>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Geometry.h"
+#include "Fitting.h"
+
+/*
+ Long-running fitting service, so that other tools can get cube fits without starting a new process for every image.
+ 
+ Requests and responses are single lines of whitespace separated fields. A request is
+     id width height x0 y0 x1 y1 ... x6 y6
+ where id is any token chosen by the caller, width and height are the size of the image the points were clicked on, and the 7 points are ordered as for geom::Objective. The response is
+     id thetaX thetaY thetaZ cameraDist scale centreX centreY rms
+ where rms is the root mean square distance in pixels between the clicked and fitted vertices, or
+     id error <message>
+ if the request couldn't be parsed, if the image size isn't positive, or if the line is too long. Responses on a connection come back in the order the requests were sent.
+ */
+
+/*
+ Worker pool which fits requests whole, in the order they arrive. Each worker takes up to maxBatch requests off the front of the queue at once to keep contention on the queue down under load, but never more than its share of what is waiting, so a burst is still spread over every worker.
+ */
+class FitService {
+public:
+    FitService(int nWorkers, int maxBatch);
+    ~FitService();  // Finishes everything already submitted, then stops the workers.
+    
+    // Queues one request line. The future gives the response line, without a newline.
+    std::future<std::string> submit(std::string request);
+    
+private:
+    struct Job {
+        std::string id;
+        double width, height;
+        std::vector<geom::Point2d> points;
+        std::promise<std::string> response;
+    };
+    void _work();
+    
+    int _nWorkers;
+    int _maxBatch;
+    bool _stopping;
+    std::deque<Job> _queue;
+    std::mutex _mutex;
+    std::condition_variable _ready;
+    std::vector<std::thread> _workers;
+};
+
+/*
+ Parses a request line. Returns an empty string if it is valid, otherwise a description of what is wrong with it.
+ */
+std::string parseRequest(std::string request,
+                         std::string& id,
+                         double& width,
+                         double& height,
+                         std::vector<geom::Point2d>& points);
+
+/*
+ Makes the response line for fitted parameters.
+ */
+std::string formatResponse(std::string id,
+                           std::vector<geom::Point2d> points,
+                           geom::vec params);
+
+/*
+ Serves requests read from inFd, writing responses to outFd, until inFd reaches end of file. Use 0 and 1 to serve over stdin/stdout.
+ 
+ Stops reading while maxPendingRequests responses are waiting to be written, so a client which sends faster than it reads is held back rather than filling memory. A line longer than maxRequestLength is dropped, and gets an error response.
+ */
+const int maxPendingRequests = 64;
+const size_t maxRequestLength = 4096;
+
+void serveConnection(FitService& service, int inFd, int outFd);
+
+/*
+ Listens on a Unix socket at path, serving each connection on its own thread. Only returns if the socket can't be set up, in which case it returns 1.
+ */
+int serveSocket(FitService& service, std::string path);
+
+#endif /* defined(__CubeSorting__Service__) */
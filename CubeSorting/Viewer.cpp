@@ -0,0 +1,151 @@
+//
+//  Viewer.cpp
+//  CubeSorting
+//
+//  Created by agent on 19/10/2026.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#include "Viewer.h"
+#include <algorithm>
+#include <cmath>
+#include <opencv2/highgui/highgui.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "GeomCV.h"
+#include "Fitting.h"
+
+
+Viewer::Viewer(cv::Mat image, int width, int height)
+: _width(width), _height(height) {
+    _pyramid.push_back(image);
+    _zoom = std::min((double)width/image.cols, (double)height/image.rows);
+    _x0 = (image.cols - width/_zoom)/2;
+    _y0 = (image.rows - height/_zoom)/2;
+}
+
+int Viewer::cols(){
+    return _pyramid[0].cols;
+}
+
+int Viewer::rows(){
+    return _pyramid[0].rows;
+}
+
+cv::Mat Viewer::_level(int k){
+    while (_pyramid.size() <= k) {
+        cv::Mat down;
+        cv::pyrDown(_pyramid.back(), down);
+        _pyramid.push_back(down);
+    }
+    return _pyramid[k];
+}
+
+cv::Mat Viewer::render(){
+    cv::Mat view(_height, _width, CV_8UC3, cv::Scalar(0,0,0));
+    
+    // Smallest level with at least one pixel per window pixel.
+    int k = 0;
+    while (std::ldexp(_zoom, k + 1) <= 1 && std::min(_level(k).cols, _level(k).rows) > 1) {
+        ++k;
+    }
+    cv::Mat level = _level(k);
+    double levelScale = (double)level.cols/cols();
+    
+    // Visible part of the level, clipped to the image.
+    int left = std::max(0, (int)std::floor(_x0*levelScale));
+    int top = std::max(0, (int)std::floor(_y0*levelScale));
+    int right = std::min(level.cols, (int)std::ceil((_x0 + _width/_zoom)*levelScale));
+    int bottom = std::min(level.rows, (int)std::ceil((_y0 + _height/_zoom)*levelScale));
+    if (right > left && bottom > top) {
+        // Where that part lands in the window.
+        cv::Point from = toWindow(geom::Point2d(left/levelScale, top/levelScale));
+        cv::Point to = toWindow(geom::Point2d(right/levelScale, bottom/levelScale));
+        cv::Rect source(left, top, right - left, bottom - top);
+        cv::Rect target(from.x, from.y, to.x - from.x, to.y - from.y);
+        cv::Rect clipped = target & cv::Rect(0, 0, _width, _height);
+        if (clipped.area() > 0) {
+            cv::Mat part;
+            // Show individual pixels when zoomed right in, to click on them precisely.
+            int interpolation = _zoom > 1 ? cv::INTER_NEAREST : cv::INTER_LINEAR;
+            cv::resize(level(source), part, target.size(), 0, 0, interpolation);
+            part(cv::Rect(clipped.x - target.x, clipped.y - target.y,
+                          clipped.width, clipped.height)).copyTo(view(clipped));
+        }
+    }
+    
+    // Cubes, moved into window coordinates.
+    for (auto cube = cubes.begin(); cube != cubes.end(); ++cube) {
+        geom::vec params = cube->getParams();
+        params[4] *= _zoom;
+        params[5] = (params[5] - _x0)*_zoom;
+        params[6] = (params[6] - _y0)*_zoom;
+        drawCube(view, geom::Cube(params));
+    }
+    
+    // Alternate colours so that each cube's group of clicks can be told apart.
+    for (int i = 0; i < points.size(); ++i) {
+        cv::Scalar colour = (i/geom::pointsPerCube) % 2 ? cv::Scalar(0,0,255) : cv::Scalar(255,0,0);
+        cv::circle(view, toWindow(points[i]), 5, colour, -1);
+    }
+    return view;
+}
+
+geom::Point2d Viewer::toImage(int x, int y){
+    return geom::Point2d(_x0 + x/_zoom, _y0 + y/_zoom);
+}
+
+cv::Point Viewer::toWindow(geom::Point2d p){
+    return cv::Point((int)std::lround((p.xy[0] - _x0)*_zoom),
+                     (int)std::lround((p.xy[1] - _y0)*_zoom));
+}
+
+void Viewer::zoomAt(int x, int y, double factor){
+    geom::Point2d fixed = toImage(x, y);
+    // No further out than the whole image, no further in than 32 window pixels per image pixel.
+    double fit = std::min((double)_width/cols(), (double)_height/rows());
+    _zoom = std::max(fit, std::min(32.0, _zoom*factor));
+    _x0 = fixed.xy[0] - x/_zoom;
+    _y0 = fixed.xy[1] - y/_zoom;
+    _clamp();
+}
+
+void Viewer::pan(int dx, int dy){
+    _x0 -= dx/_zoom;
+    _y0 -= dy/_zoom;
+    _clamp();
+}
+
+void Viewer::_clamp(){
+    // Keep the middle of the window over the image.
+    _x0 = std::max(-_width/(2*_zoom), std::min(cols() - _width/(2*_zoom), _x0));
+    _y0 = std::max(-_height/(2*_zoom), std::min(rows() - _height/(2*_zoom), _y0));
+}
+
+int Viewer::waitForKey(std::string window, std::function<bool()> refresh){
+    cv::imshow(window, render());
+    while (true) {
+        int k = cv::waitKey(refresh ? 50 : 0);
+        if (k == -1) {
+            if (cv::getWindowProperty(window, cv::WND_PROP_VISIBLE) < 1) {
+                return -1;  // the window has been closed
+            }
+            if (refresh && refresh()) {
+                cv::imshow(window, render());
+            }
+            continue;
+        }
+        if (k == '+' || k == '=') {
+            zoomAt(_width/2, _height/2, 2);
+        } else if (k == '-' || k == '_') {
+            zoomAt(_width/2, _height/2, 0.5);
+        } else if (k == '0') {
+            zoomAt(_width/2, _height/2, 0);
+            _x0 = (cols() - _width/_zoom)/2;
+            _y0 = (rows() - _height/_zoom)/2;
+        } else {
+            return k;
+        }
+        cv::imshow(window, render());
+    }
+}
@@ -0,0 +1,75 @@
+//
+//  Viewer.h
+//  CubeSorting
+//
+//  Created by agent on 19/10/2026.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#ifndef __CubeSorting__Viewer__
+#define __CubeSorting__Viewer__
+
+#include <stdio.h>
+#include <functional>
+#include <string>
+#include <vector>
+#include <opencv2/core/core.hpp>
+
+#include "Geometry.h"
+
+/*
+ Zoomable, pannable view of an image at its full resolution, for clicking on large images.
+ 
+ A pyramid of successively halved copies of the image is built as the levels are needed and kept. Rendering picks the smallest level which still has at least as many pixels as the window shows, and only resizes the part of it which is visible, so the cost of a redraw depends on the window size rather than the image size.
+ 
+ Clicked points and fitted cubes are kept in full resolution coordinates and drawn onto the rendered view, so the image itself is never modified.
+ */
+class Viewer {
+public:
+    /*
+     Takes the full resolution image and the size of the window to show it in. Starts zoomed out to fit the whole image in the window.
+     */
+    Viewer(cv::Mat image, int width, int height);
+    
+    // Renders what is currently visible, with points and cubes drawn on top.
+    cv::Mat render();
+    
+    // Converts window coordinates to full resolution image coordinates, and back.
+    geom::Point2d toImage(int x, int y);
+    cv::Point toWindow(geom::Point2d p);
+    
+    // Zooms in by factor (out if less than 1) keeping the image point under window position (x, y) fixed.
+    void zoomAt(int x, int y, double factor);
+    
+    // Moves the view by (dx, dy) window pixels.
+    void pan(int dx, int dy);
+    
+    /*
+     Shows the view in the named window and waits for a key press. Zoom keys (+, - and 0 to zoom out to the whole image) are handled here, any other key is returned. Returns -1 if the window is closed.
+     
+     If refresh is given it is polled while waiting, and the view is redrawn whenever it returns true. This lets cubes which are still being refined update on screen.
+     */
+    int waitForKey(std::string window, std::function<bool()> refresh = nullptr);
+    
+    int cols();
+    int rows();
+    
+    std::vector<geom::Point2d> points;  // Clicked points, in groups of 7 per cube
+    std::vector<geom::Cube> cubes;      // Fitted cubes
+    
+    // Used by CallBackFunc to pan with the right button held down.
+    cv::Point dragFrom;
+    
+private:
+    cv::Mat _level(int k);  // The image halved k times
+    void _clamp();
+    
+    std::vector<cv::Mat> _pyramid;
+    int _width;
+    int _height;
+    double _zoom;  // Window pixels per full resolution pixel
+    double _x0;    // Full resolution coordinates of the top left of the window
+    double _y0;
+};
+
+#endif /* defined(__CubeSorting__Viewer__) */
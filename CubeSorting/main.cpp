@@ -10,14 +10,23 @@
 #include <fstream>
 #include <sstream>
 #include <vector>
+#include <map>
 #include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <thread>
 #include <opencv2/core/core.hpp>
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 
-#include "GradDesc.h"
 #include "Geometry.h"
+#include "Fitting.h"
 #include "GeomCV.h"
+#include "Render.h"
+#include "Viewer.h"
+#include "Service.h"
+#include "Benchmark.h"
 
 using namespace cv;
 
@@ -35,6 +44,11 @@ int main(int argc, const char * argv[]) {
     std::string outputDirectory = "";
     int width = 480;
     int height = 640;
+    std::string fitsFile = "";
+    int sheetColumns = 0;
+    int budget = 200;
+    int benchmarkCubes = 0;
+    std::string serviceAddress = "";
     
     if(argc == 1) return usage();
     
@@ -51,6 +65,7 @@ int main(int argc, const char * argv[]) {
         switch ( switchChar ) {
             case 'i':
                 ss >> inputDirectory;
+                break;
             
             case 'o':
                 ss >> outputDirectory;
@@ -64,11 +79,71 @@ int main(int argc, const char * argv[]) {
                 ss >> height;
                 break;
                 
+            case 'r':
+                ss >> fitsFile;
+                break;
+                
+            case 's':
+                ss >> sheetColumns;
+                break;
+                
+            case 'd':
+                ss >> serviceAddress;
+                break;
+                
+            case 't':
+                ss >> budget;
+                break;
+                
+            case 'b':
+                ss >> benchmarkCubes;
+                break;
+                
             default:
                 usage();
         }
     }
     
+    if (benchmarkCubes > 0) {
+        return benchmarkPrecision(benchmarkCubes);
+    }
+    
+    if (serviceAddress != "") {
+        // Service mode: fit point sets sent by other programs.
+        FitService service(std::max(1, (int)std::thread::hardware_concurrency()), 8);
+        if (serviceAddress == "-") {
+            serveConnection(service, 0, 1);
+            return 0;
+        }
+        return serveSocket(service, serviceAddress);
+    }
+    
+    if (fitsFile != "") {
+        // Headless mode: draw the saved fits instead of asking for new ones.
+        bool fullResolution;
+        std::map<int, std::vector<geom::vec>> fits;
+        if (!readFits(fitsFile, fits, fullResolution)) {
+            std::cout << "Could not open fits file " << fitsFile << std::endl;
+            return 1;
+        }
+        // Older files are in the frame of the image resized to -w x -h.
+        int fitWidth = fullResolution ? 0 : width;
+        int fitHeight = fullResolution ? 0 : height;
+        if (!fullResolution) {
+            std::cout << "No full resolution header, so taking the fits to be on images resized to "
+                      << width << "x" << height << "." << std::endl;
+        }
+        if (sheetColumns > 0) {
+            int n = renderContactSheets(fits, inputDirectory, outputDirectory,
+                                        fitWidth, fitHeight, width/4, height/4, sheetColumns);
+            std::cout << "Wrote " << n << " contact sheets." << std::endl;
+        } else {
+            int n = renderOverlays(fits, inputDirectory, outputDirectory, fitWidth, fitHeight);
+            std::cout << "Wrote " << n << " overlays." << std::endl;
+        }
+        return 0;
+    }
+    
     std::string inFile = "";
     std::string outFile = "";
     
@@ -76,6 +151,9 @@ int main(int argc, const char * argv[]) {
     std::ofstream output;
     outFile = "out.csv";
     output.open(outputDirectory + outFile);
+    output << fullResolutionHeader << "\n";
+    
+    geom::FitScheduler scheduler(std::max(1, (int)std::thread::hardware_concurrency()));
     
     for (int i = 1;;i++) {
         // Read image
@@ -85,64 +163,96 @@ int main(int argc, const char * argv[]) {
             break;
         }
         
-        Mat image;
-        resize(img, image, Size(width, height));
-        
-        // Check
-        if (image.empty()) {
-            std::cout << "Error loading image" << std::endl;
-            return -1;
-        }
-        
         // Get user input
         namedWindow("Cube");
         
-        std::vector<geom::Point2d> points;
-        std::vector<void*> data;
-        data.push_back((void*)&points);
-        data.push_back((void*)&image);
-        setMouseCallback("Cube", CallBackFunc, (void*)&data);
+        Viewer viewer(img, width, height);
+        setMouseCallback("Cube", CallBackFunc, (void*)&viewer);
+        viewer.waitForKey("Cube");
         
-        imshow("Cube", image);
-        waitKey();
-        
-        // Process user input
-        geom::Objective F(points);  // Construct objective function with seen data
+        // Process user input. Every 7 clicks describe one cube.
+        std::vector<geom::Point2d> points = viewer.points;
+        int nCubes = (int)points.size()/geom::pointsPerCube;
+        if (points.size() % geom::pointsPerCube != 0) {
+            std::cout << "Ignoring " << points.size() % geom::pointsPerCube
+                      << " clicks left over after the last complete cube." << std::endl;
+        }
+        std::vector<std::unique_ptr<geom::AnytimeFit>> fits;
+        for (int j = 0; j < nCubes; ++j) {
+            std::vector<geom::Point2d> group(points.begin() + j*geom::pointsPerCube,
+                                             points.begin() + (j + 1)*geom::pointsPerCube);
+            fits.push_back(std::unique_ptr<geom::AnytimeFit>(
+                new geom::AnytimeFit(scheduler, group, img.cols, img.rows)));
+        }
         
-        double pi = std::acos(-1);
-        std::vector<double> init = {0, -pi/4, -pi/4, -1, 1000, (double)width/2, (double)height/2};
-        std::vector<double> secondRate = {0.000001, 0.000001, 0.000001, 0.0001, 10, 0.01, 0.01};
-        std::vector<double> theta = gd::gradientDescent<geom::Objective>(F, init, secondRate, 10);
+        // Show whatever the fits have got to within the budget...
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(budget);
+        for (auto fit = fits.begin(); fit != fits.end(); ++fit) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            (*fit)->waitFor(std::max(left, std::chrono::milliseconds(0)));
+        }
         
-        geom::Cube fitCube(theta);
+        // ...and pick up improvements as they come in while the user looks.
+        std::vector<int> versions(nCubes, -1);
+        auto update = [&]() {
+            bool changed = false;
+            for (int j = 0; j < nCubes; ++j) {
+                int version = fits[j]->version();
+                if (version != versions[j]) {
+                    versions[j] = version;
+                    changed = true;
+                }
+            }
+            if (changed) {
+                viewer.cubes.clear();
+                for (int j = 0; j < nCubes; ++j) {
+                    viewer.cubes.push_back(geom::Cube(fits[j]->best()));
+                }
+            }
+            return changed;
+        };
+        update();
         
-        drawCube(image, fitCube);
-        for (int i = 0; i < theta.size(); ++i) {
-            std::cout << theta[i] << " ";
+        for (auto fitCube = viewer.cubes.begin(); fitCube != viewer.cubes.end(); ++fitCube) {
+            geom::vec theta = fitCube->getParams();
+            for (int p = 0; p < theta.size(); ++p) {
+                std::cout << theta[p] << " ";
+            }
+            std::cout << std::endl;
         }
-        std::cout << std::endl;
         
-        imshow("Cube", image);
-        int k = waitKey();
+        int k = viewer.waitForKey("Cube", update);
         
         if (k == 13 || k == 32){
-            // accept the fitted cube
-            std::cout << "Exporting data..." << std::endl;
-            std::vector<geom::Point2d> projected = fitCube.projectPoints();
-            geom::vec params = fitCube.getParams();
-            output << std::to_string(i);
-            for (int i = 0; i < projected.size(); i++) {
-                output << "," << projected[i].xy[0] << " " << projected[i].xy[1];
+            // accept the fitted cubes, once they have converged, one record per cube
+            for (auto fit = fits.begin(); fit != fits.end(); ++fit) {
+                if (!(*fit)->finished()) {
+                    std::cout << "Waiting for fits to finish..." << std::endl;
+                    break;
+                }
             }
-            output << "\n";
-            for (int i = 0; i < params.size(); i++) {
-                output << "," << params[i];
+            for (auto fit = fits.begin(); fit != fits.end(); ++fit) {
+                (*fit)->wait();
+            }
+            update();
+            std::vector<geom::Cube> cubes = viewer.cubes;
+            std::cout << "Exporting data..." << std::endl;
+            for (auto fitCube = cubes.begin(); fitCube != cubes.end(); ++fitCube) {
+                std::vector<geom::Point2d> projected = fitCube->projectPoints();
+                geom::vec params = fitCube->getParams();
+                output << std::to_string(i);
+                for (int i = 0; i < projected.size(); i++) {
+                    output << "," << projected[i].xy[0] << " " << projected[i].xy[1];
+                }
+                output << "\n";
+                for (int i = 0; i < params.size(); i++) {
+                    output << "," << params[i];
+                }
+                output << "\n";
             }
-            output << "\n";
-            
         }
         else{
-            // reject the fitted cube
+            // reject the fitted cubes
             std::cout << "Moving swiftly on..." << std::endl;
         }
     }
@@ -158,7 +268,14 @@ int usage(){
     std::cout << "Usage: CubeSorting [options] (defaults in brackets)" << std::endl;
     std::cout << "-i [input directory]" << std::endl;
     std::cout << "-o [output directory]" << std::endl;
-    std::cout << "-w [resize width] (480)" << std::endl;
-    std::cout << "-h [resize height] (640)" << std::endl;
+    std::cout << "-w [window width] (480)" << std::endl;
+    std::cout << "-h [window height] (640)" << std::endl;
+    std::cout << "-r [fits file] render saved fits from e.g. out.csv without the GUI" << std::endl;
+    std::cout << "   out.csv now holds full resolution coordinates, marked by a header line. Files without it" << std::endl;
+    std::cout << "   are from older versions and are taken to be on images resized to -w x -h." << std::endl;
+    std::cout << "-s [columns] with -r, write contact sheets of columns x columns images (0 = one overlay per image)" << std::endl;
+    std::cout << "-t [milliseconds] (200) time to wait for fits before showing them; they keep improving on screen" << std::endl;
+    std::cout << "-d [socket path] run as a fitting service on a Unix socket, or on stdin/stdout if the path is -" << std::endl;
+    std::cout << "-b [number of cubes] compare float and double fitting accuracy and speed on synthetic cubes" << std::endl;
     return 1;
 }